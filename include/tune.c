@@ -0,0 +1,123 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "tune.h"
+
+static const char *algorithm_names[BLUR_ALGORITHM_COUNT] = {"direct", "tiled", "transpose", "box"};
+
+const char *tune_algorithm_name(enum blur_algorithm algorithm)
+{
+    return algorithm_names[algorithm];
+}
+
+struct tune_config default_tune_config(void)
+{
+    struct tune_config config = {BLUR_DIRECT, 0, 1};
+    return config;
+}
+
+int load_tune_profile(const char *filename, struct tune_profile *profile)
+{
+    profile->count = 0;
+    profile->entries = NULL;
+
+    FILE *fp = fopen(filename, "r");
+    if (!fp)
+        return 0;
+
+    int capacity = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), fp))
+    {
+        // Skip comments and blank lines, including "\r\n" ones from files edited on Windows
+        if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0')
+            continue;
+
+        struct tune_entry entry;
+        char name[32];
+        if (sscanf(line, "%d %d %31s %d %d %lf", &entry.size, &entry.radius, name,
+                   &entry.config.tile, &entry.config.threads, &entry.seconds) != 6)
+        {
+            fprintf(stderr, "Malformed tuning profile line in %s: %s", filename, line);
+            exit(EXIT_FAILURE);
+        }
+
+        int algorithm = -1;
+        for (int i = 0; i < BLUR_ALGORITHM_COUNT; i++)
+        {
+            if (strcmp(name, algorithm_names[i]) == 0)
+                algorithm = i;
+        }
+        // Every algorithm but direct steps through the image by `tile` pixels
+        if (algorithm < 0 || entry.config.threads < 1 ||
+            (algorithm != BLUR_DIRECT && entry.config.tile < 1))
+        {
+            fprintf(stderr, "Invalid tuning profile entry in %s: %s", filename, line);
+            exit(EXIT_FAILURE);
+        }
+        entry.config.algorithm = (enum blur_algorithm)algorithm;
+
+        if (profile->count == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 16;
+            profile->entries = (struct tune_entry *)realloc(profile->entries, capacity * sizeof(struct tune_entry));
+        }
+        profile->entries[profile->count++] = entry;
+    }
+
+    fclose(fp);
+    return 1;
+}
+
+void save_tune_profile(const char *filename, const struct tune_profile *profile)
+{
+    FILE *fp = fopen(filename, "w");
+    if (!fp)
+    {
+        perror("File could not be opened for writing");
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(fp, "# Gaussian blur tuning profile\n");
+    fprintf(fp, "# size radius algorithm tile threads seconds\n");
+    for (int i = 0; i < profile->count; i++)
+    {
+        const struct tune_entry *entry = &profile->entries[i];
+        fprintf(fp, "%d %d %s %d %d %f\n", entry->size, entry->radius,
+                algorithm_names[entry->config.algorithm], entry->config.tile,
+                entry->config.threads, entry->seconds);
+    }
+
+    fclose(fp);
+}
+
+struct tune_config select_tune_config(const struct tune_profile *profile, int width, int height, int radius)
+{
+    struct tune_config config = default_tune_config();
+    double best_distance = INFINITY;
+    // Calibration uses square images, so compare against the side of a square with the same area
+    double size = sqrt((double)width * height);
+
+    // Nearest calibration point, measured on a log scale since both axes were swept geometrically
+    for (int i = 0; i < profile->count; i++)
+    {
+        const struct tune_entry *entry = &profile->entries[i];
+        double distance = fabs(log(size / entry->size)) +
+                          fabs(log((double)radius / entry->radius));
+        if (distance < best_distance)
+        {
+            best_distance = distance;
+            config = entry->config;
+        }
+    }
+
+    return config;
+}
+
+void free_tune_profile(struct tune_profile *profile)
+{
+    free(profile->entries);
+    profile->entries = NULL;
+    profile->count = 0;
+}
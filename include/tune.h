@@ -0,0 +1,92 @@
+#ifndef TUNE_H
+#define TUNE_H
+
+/**
+ * CPU code paths available for the separable Gaussian blur
+ */
+enum blur_algorithm
+{
+    BLUR_DIRECT,    // Row-major horizontal and vertical passes
+    BLUR_TILED,     // Vertical pass walks the image in column strips of `tile` pixels
+    BLUR_TRANSPOSE, // Vertical pass runs as a horizontal pass on a blocked transpose
+    BLUR_BOX,       // Running-sum box filters approximating the Gaussian, cost independent of radius
+    BLUR_ALGORITHM_COUNT
+};
+
+/**
+ * Strategy used for a single blur job
+ */
+struct tune_config
+{
+    enum blur_algorithm algorithm;
+    int tile;    // Column strip width (tiled) or transpose block size (transpose, box), unused by direct
+    int threads; // Number of worker threads
+};
+
+/**
+ * Fastest strategy measured for one (image size, blur radius) calibration point
+ */
+struct tune_entry
+{
+    int size; // Side of the square calibration image
+    int radius;
+    struct tune_config config;
+    double seconds;
+};
+
+/**
+ * Tuning profile produced by calibration
+ */
+struct tune_profile
+{
+    int count;
+    struct tune_entry *entries;
+};
+
+/**
+ * Returns the name used for an algorithm in tuning profiles
+ *
+ * @param algorithm Algorithm identifier
+ */
+const char *tune_algorithm_name(enum blur_algorithm algorithm);
+
+/**
+ * Returns the configuration used when no tuning profile is available
+ */
+struct tune_config default_tune_config(void);
+
+/**
+ * Loads a tuning profile from disk
+ *
+ * @param filename Path to the profile file
+ * @param profile Profile to fill, entries must be released with free_tune_profile
+ * @return 1 if the profile was loaded, 0 if the file does not exist
+ */
+int load_tune_profile(const char *filename, struct tune_profile *profile);
+
+/**
+ * Writes a tuning profile to disk
+ *
+ * @param filename Path to the profile file
+ * @param profile Profile to write
+ */
+void save_tune_profile(const char *filename, const struct tune_profile *profile);
+
+/**
+ * Picks the strategy of the calibration point closest to the given job
+ *
+ * @param profile Loaded tuning profile, may be empty
+ * @param width Image width
+ * @param height Image height
+ * @param radius Blur radius
+ */
+struct tune_config select_tune_config(const struct tune_profile *profile, int width, int height, int radius);
+
+/**
+ * Releases the entries of a tuning profile
+ *
+ * @param profile Profile to free
+ */
+void free_tune_profile(struct tune_profile *profile);
+
+#endif /* TUNE_H */
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <png.h>
+#include <time.h>
 
 void read_png_file(const char *filename, png_bytep **row_pointers, int *width, int *height)
 {
@@ -141,3 +142,10 @@ void write_png_file(const char *filename, png_bytep *row_pointers, int width, in
     fclose(fp);
     png_destroy_write_struct(&png, &info);
 }
+
+double get_wall_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
@@ -23,4 +23,11 @@ void read_png_file(const char *filename, png_bytep **row_pointers, int *width, i
  */
 void write_png_file(const char *filename, png_bytep *row_pointers, int width, int height);
 
+/**
+ * Returns a monotonic wall-clock timestamp
+ *
+ * @return Time in seconds since an arbitrary fixed point
+ */
+double get_wall_time(void);
+
 #endif /* UTIL_H */
\ No newline at end of file
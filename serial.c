@@ -5,23 +5,42 @@
 #include <time.h>
 #include <string.h>
 #include <stdint.h> // Include this header for uint8_t
+#include <unistd.h>
+#include <pthread.h>
 #include "include/util.h"
+#include "include/tune.h"
 
-// Apply Gaussian blur with a configurable kernel size
-void apply_gaussian_blur(png_bytep *row_pointers, int width, int height, int radius)
+#define DEFAULT_PROFILE "tune_profile.txt"
+#define CALIBRATION_MIN_TIME 0.25 // Seconds of measured work per calibration timing
+#define CALIBRATION_MARGIN 0.9    // A strategy must take under this fraction of the current best to replace it
+#define BOX_PASSES 3
+
+// One stage of the blur, split across worker threads by destination row
+struct blur_pass
 {
-    // Create a copy of the image to read from while writing to the original
-    png_bytep *temp_rows = (png_bytep *)malloc(sizeof(png_bytep) * height);
-    for (int y = 0; y < height; y++)
-    {
-        temp_rows[y] = (png_byte *)malloc(width * 4);
-        memcpy(temp_rows[y], row_pointers[y], width * 4);
-    }
+    png_bytep *src;
+    png_bytep *dst;
+    int width;  // Width of the destination image
+    int height; // Height of the destination image
+    int radius;
+    const float *kernel;
+    int tile;
+    void (*run)(const struct blur_pass *pass, int begin, int end);
+};
 
+struct blur_worker
+{
+    const struct blur_pass *pass;
+    int begin;
+    int end;
+};
+
+// Create a normalized Gaussian kernel of size 2 * radius + 1
+float *create_gaussian_kernel(int radius)
+{
     // Calculate sigma based on radius
     float sigma = radius / 2.0;
 
-    // Create Gaussian kernel
     int kernel_size = 2 * radius + 1;
     float *kernel = (float *)malloc(kernel_size * sizeof(float));
     float sum = 0.0;
@@ -40,8 +59,16 @@ void apply_gaussian_blur(png_bytep *row_pointers, int width, int height, int rad
         kernel[i] /= sum;
     }
 
-    // Apply horizontal blur first (into a temporary buffer)
-    for (int y = 0; y < height; y++)
+    return kernel;
+}
+
+// Horizontal blur of rows [begin, end)
+void horizontal_pass(const struct blur_pass *pass, int begin, int end)
+{
+    int width = pass->width;
+    int radius = pass->radius;
+
+    for (int y = begin; y < end; y++)
     {
         for (int x = 0; x < width; x++)
         {
@@ -56,8 +83,8 @@ void apply_gaussian_blur(png_bytep *row_pointers, int width, int height, int rad
                 if (ix >= width)
                     ix = width - 1;
 
-                png_bytep px = &(temp_rows[y][ix * 4]);
-                float weight = kernel[i + radius];
+                png_bytep px = &(pass->src[y][ix * 4]);
+                float weight = pass->kernel[i + radius];
 
                 r += px[0] * weight;
                 g += px[1] * weight;
@@ -65,25 +92,24 @@ void apply_gaussian_blur(png_bytep *row_pointers, int width, int height, int rad
                 a += px[3] * weight;
             }
 
-            // Write result back to original image
-            png_bytep out_px = &(row_pointers[y][x * 4]);
+            png_bytep out_px = &(pass->dst[y][x * 4]);
             out_px[0] = (uint8_t)r;
             out_px[1] = (uint8_t)g;
             out_px[2] = (uint8_t)b;
             out_px[3] = (uint8_t)a;
         }
     }
+}
 
-    // Copy the current result back to temp for the vertical pass
-    for (int y = 0; y < height; y++)
-    {
-        memcpy(temp_rows[y], row_pointers[y], width * 4);
-    }
+// Vertical blur of rows [begin, end), sweeping full rows
+void vertical_pass(const struct blur_pass *pass, int begin, int end)
+{
+    int height = pass->height;
+    int radius = pass->radius;
 
-    // Apply vertical blur
-    for (int y = 0; y < height; y++)
+    for (int y = begin; y < end; y++)
     {
-        for (int x = 0; x < width; x++)
+        for (int x = 0; x < pass->width; x++)
         {
             float r = 0, g = 0, b = 0, a = 0;
 
@@ -96,8 +122,8 @@ void apply_gaussian_blur(png_bytep *row_pointers, int width, int height, int rad
                 if (iy >= height)
                     iy = height - 1;
 
-                png_bytep px = &(temp_rows[iy][x * 4]);
-                float weight = kernel[i + radius];
+                png_bytep px = &(pass->src[iy][x * 4]);
+                float weight = pass->kernel[i + radius];
 
                 r += px[0] * weight;
                 g += px[1] * weight;
@@ -105,30 +131,541 @@ void apply_gaussian_blur(png_bytep *row_pointers, int width, int height, int rad
                 a += px[3] * weight;
             }
 
-            // Write result back to original image
-            png_bytep out_px = &(row_pointers[y][x * 4]);
+            png_bytep out_px = &(pass->dst[y][x * 4]);
             out_px[0] = (uint8_t)r;
             out_px[1] = (uint8_t)g;
             out_px[2] = (uint8_t)b;
             out_px[3] = (uint8_t)a;
         }
     }
+}
 
-    // Free temporary image
+// Vertical blur of rows [begin, end), one column strip at a time so the
+// 2 * radius + 1 source rows touched by a strip stay in cache
+void vertical_tiled_pass(const struct blur_pass *pass, int begin, int end)
+{
+    int height = pass->height;
+    int radius = pass->radius;
+
+    for (int x0 = 0; x0 < pass->width; x0 += pass->tile)
+    {
+        int x1 = x0 + pass->tile < pass->width ? x0 + pass->tile : pass->width;
+        for (int y = begin; y < end; y++)
+        {
+            for (int x = x0; x < x1; x++)
+            {
+                float r = 0, g = 0, b = 0, a = 0;
+
+                for (int i = -radius; i <= radius; i++)
+                {
+                    int iy = y + i;
+                    // Handle boundary conditions
+                    if (iy < 0)
+                        iy = 0;
+                    if (iy >= height)
+                        iy = height - 1;
+
+                    png_bytep px = &(pass->src[iy][x * 4]);
+                    float weight = pass->kernel[i + radius];
+
+                    r += px[0] * weight;
+                    g += px[1] * weight;
+                    b += px[2] * weight;
+                    a += px[3] * weight;
+                }
+
+                png_bytep out_px = &(pass->dst[y][x * 4]);
+                out_px[0] = (uint8_t)r;
+                out_px[1] = (uint8_t)g;
+                out_px[2] = (uint8_t)b;
+                out_px[3] = (uint8_t)a;
+            }
+        }
+    }
+}
+
+// Widths of BOX_PASSES box filters whose combination approximates a Gaussian of the given sigma
+void box_widths(float sigma, int *widths)
+{
+    float ideal = sqrtf(12 * sigma * sigma / BOX_PASSES + 1);
+    int lower = (int)floorf(ideal);
+    if (lower % 2 == 0)
+        lower--;
+    int upper = lower + 2;
+    // Number of passes that use the lower width so the combined variance matches sigma
+    int num_lower = (int)roundf((12 * sigma * sigma - BOX_PASSES * lower * lower - 4 * BOX_PASSES * lower - 3 * BOX_PASSES) /
+                                (-4.0f * lower - 4));
+
+    for (int i = 0; i < BOX_PASSES; i++)
+    {
+        widths[i] = i < num_lower ? lower : upper;
+    }
+}
+
+// Approximate horizontal Gaussian blur of rows [begin, end) with repeated box
+// filters. Each box is a running sum, so the cost per pixel does not grow with radius.
+void box_pass(const struct blur_pass *pass, int begin, int end)
+{
+    int width = pass->width;
+    int widths[BOX_PASSES];
+    // Match the variance of the truncated kernel used by the exact paths, not the nominal sigma
+    float variance = 0.0;
+    for (int i = -pass->radius; i <= pass->radius; i++)
+    {
+        variance += pass->kernel[i + pass->radius] * i * i;
+    }
+    box_widths(sqrtf(variance), widths);
+
+    int *line = (int *)malloc(width * 4 * sizeof(int));
+    int *next = (int *)malloc(width * 4 * sizeof(int));
+
+    for (int y = begin; y < end; y++)
+    {
+        for (int x = 0; x < width * 4; x++)
+        {
+            line[x] = pass->src[y][x];
+        }
+
+        for (int p = 0; p < BOX_PASSES; p++)
+        {
+            int box = widths[p];
+            int box_radius = (box - 1) / 2;
+
+            for (int c = 0; c < 4; c++)
+            {
+                // Window sum for x = 0, with the left edge clamped to the first pixel
+                int sum = (box_radius + 1) * line[c];
+                for (int i = 1; i <= box_radius; i++)
+                {
+                    sum += line[(i < width ? i : width - 1) * 4 + c];
+                }
+
+                for (int x = 0; x < width; x++)
+                {
+                    next[x * 4 + c] = (sum + box / 2) / box;
+
+                    // Slide the window one pixel to the right
+                    int add = x + box_radius + 1;
+                    int sub = x - box_radius;
+                    // Handle boundary conditions
+                    if (add >= width)
+                        add = width - 1;
+                    if (sub < 0)
+                        sub = 0;
+                    sum += line[add * 4 + c] - line[sub * 4 + c];
+                }
+            }
+
+            int *swap = line;
+            line = next;
+            next = swap;
+        }
+
+        for (int x = 0; x < width * 4; x++)
+        {
+            pass->dst[y][x] = (uint8_t)line[x];
+        }
+    }
+
+    free(line);
+    free(next);
+}
+
+// Transpose into destination rows [begin, end) using square blocks of tile pixels
+void transpose_pass(const struct blur_pass *pass, int begin, int end)
+{
+    int tile = pass->tile;
+
+    for (int y0 = begin; y0 < end; y0 += tile)
+    {
+        int y1 = y0 + tile < end ? y0 + tile : end;
+        for (int x0 = 0; x0 < pass->width; x0 += tile)
+        {
+            int x1 = x0 + tile < pass->width ? x0 + tile : pass->width;
+            for (int y = y0; y < y1; y++)
+            {
+                for (int x = x0; x < x1; x++)
+                {
+                    memcpy(&(pass->dst[y][x * 4]), &(pass->src[x][y * 4]), 4);
+                }
+            }
+        }
+    }
+}
+
+static void *blur_worker_main(void *arg)
+{
+    struct blur_worker *worker = (struct blur_worker *)arg;
+    worker->pass->run(worker->pass, worker->begin, worker->end);
+    return NULL;
+}
+
+// Run a pass over all destination rows, splitting them evenly across threads
+void run_pass(const struct blur_pass *pass, int threads)
+{
+    if (threads > pass->height)
+        threads = pass->height;
+    if (threads <= 1)
+    {
+        pass->run(pass, 0, pass->height);
+        return;
+    }
+
+    pthread_t *ids = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    struct blur_worker *workers = (struct blur_worker *)malloc(threads * sizeof(struct blur_worker));
+    int rows_per_thread = pass->height / threads;
+    int remainder = pass->height % threads;
+    int begin = 0;
+
+    for (int t = 0; t < threads; t++)
+    {
+        workers[t].pass = pass;
+        workers[t].begin = begin;
+        workers[t].end = begin + rows_per_thread + (t < remainder ? 1 : 0);
+        begin = workers[t].end;
+        if (pthread_create(&ids[t], NULL, blur_worker_main, &workers[t]) != 0)
+        {
+            perror("pthread_create failed");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int t = 0; t < threads; t++)
+    {
+        pthread_join(ids[t], NULL);
+    }
+
+    free(ids);
+    free(workers);
+}
+
+png_bytep *allocate_rows(int width, int height)
+{
+    png_bytep *rows = (png_bytep *)malloc(sizeof(png_bytep) * height);
+    for (int y = 0; y < height; y++)
+    {
+        rows[y] = (png_byte *)malloc(width * 4);
+    }
+    return rows;
+}
+
+void free_rows(png_bytep *rows, int height)
+{
     for (int y = 0; y < height; y++)
     {
-        free(temp_rows[y]);
+        free(rows[y]);
+    }
+    free(rows);
+}
+
+// Apply Gaussian blur with a configurable kernel size using the given strategy
+void apply_gaussian_blur(png_bytep *row_pointers, int width, int height, int radius, struct tune_config config)
+{
+    float *kernel = create_gaussian_kernel(radius);
+    png_bytep *temp_rows = allocate_rows(width, height);
+    void (*row_blur)(const struct blur_pass *, int, int) = config.algorithm == BLUR_BOX ? box_pass : horizontal_pass;
+    struct blur_pass pass = {row_pointers, temp_rows, width, height, radius, kernel, config.tile, row_blur};
+
+    // Apply horizontal blur first (into a temporary buffer)
+    run_pass(&pass, config.threads);
+
+    if (config.algorithm == BLUR_TRANSPOSE || config.algorithm == BLUR_BOX)
+    {
+        // Turn columns into rows so the vertical pass becomes a row-major horizontal pass
+        png_bytep *columns = allocate_rows(height, width);
+        png_bytep *blurred_columns = allocate_rows(height, width);
+
+        struct blur_pass to_columns = {temp_rows, columns, height, width, radius, kernel, config.tile, transpose_pass};
+        run_pass(&to_columns, config.threads);
+
+        struct blur_pass blur_columns = {columns, blurred_columns, height, width, radius, kernel, config.tile, row_blur};
+        run_pass(&blur_columns, config.threads);
+
+        struct blur_pass to_rows = {blurred_columns, row_pointers, width, height, radius, kernel, config.tile, transpose_pass};
+        run_pass(&to_rows, config.threads);
+
+        free_rows(columns, width);
+        free_rows(blurred_columns, width);
+    }
+    else
+    {
+        // Apply vertical blur back into the original image
+        struct blur_pass vertical = {temp_rows, row_pointers, width, height, radius, kernel, config.tile,
+                                     config.algorithm == BLUR_TILED ? vertical_tiled_pass : vertical_pass};
+        run_pass(&vertical, config.threads);
     }
-    free(temp_rows);
+
+    // Free temporary image
+    free_rows(temp_rows, height);
     free(kernel);
 }
 
+// Build per-output-coordinate Gaussian weights for resampling `in_size` pixels to `out_size`.
+// Each output pixel gets `*taps` weights starting at source index `starts[o]` (unclamped).
+float *create_resample_weights(int in_size, int out_size, float sigma, int **starts, int *taps)
+{
+    float step = (float)in_size / out_size;
+    int tap_radius = (int)ceilf(2 * sigma);
+    *taps = 2 * tap_radius + 1;
+    *starts = (int *)malloc(out_size * sizeof(int));
+    float *weights = (float *)malloc(out_size * (*taps) * sizeof(float));
+
+    for (int o = 0; o < out_size; o++)
+    {
+        // Center of the output pixel in source coordinates
+        float center = (o + 0.5f) * step - 0.5f;
+        int start = (int)floorf(center + 0.5f) - tap_radius;
+        float *w = &weights[o * (*taps)];
+        float sum = 0.0;
+
+        for (int i = 0; i < *taps; i++)
+        {
+            float x = start + i - center;
+            w[i] = exp(-(x * x) / (2 * sigma * sigma));
+            sum += w[i];
+        }
+        for (int i = 0; i < *taps; i++)
+        {
+            w[i] /= sum;
+        }
+        (*starts)[o] = start;
+    }
+
+    return weights;
+}
+
+// Apply Gaussian blur and decimate to out_width x out_height in one go. Only the
+// source columns feeding an output column are blurred horizontally, and only the
+// output rows are blurred vertically. The kernel is widened by the anti-aliasing
+// sigma of the decimation. Like apply_gaussian_blur, the horizontal result is
+// truncated to 8 bits between the passes, so scale 1 matches it exactly.
+// Returns newly allocated rows of the reduced image.
+png_bytep *apply_gaussian_blur_downscale(png_bytep *row_pointers, int width, int height, int radius,
+                                         int out_width, int out_height)
+{
+    float sigma = radius / 2.0;
+    float aa_x = ((float)width / out_width - 1) / 2;
+    float aa_y = ((float)height / out_height - 1) / 2;
+
+    int *x_starts, *y_starts;
+    int x_taps, y_taps;
+    float *x_weights = create_resample_weights(width, out_width, sqrtf(sigma * sigma + aa_x * aa_x), &x_starts, &x_taps);
+    float *y_weights = create_resample_weights(height, out_height, sqrtf(sigma * sigma + aa_y * aa_y), &y_starts, &y_taps);
+
+    // Horizontal pass: full-height, but only the output columns
+    png_bytep *temp_rows = allocate_rows(out_width, height);
+    for (int y = 0; y < height; y++)
+    {
+        for (int ox = 0; ox < out_width; ox++)
+        {
+            float r = 0, g = 0, b = 0, a = 0;
+            const float *w = &x_weights[ox * x_taps];
+
+            for (int i = 0; i < x_taps; i++)
+            {
+                int ix = x_starts[ox] + i;
+                // Handle boundary conditions
+                if (ix < 0)
+                    ix = 0;
+                if (ix >= width)
+                    ix = width - 1;
+
+                png_bytep px = &(row_pointers[y][ix * 4]);
+                r += px[0] * w[i];
+                g += px[1] * w[i];
+                b += px[2] * w[i];
+                a += px[3] * w[i];
+            }
+
+            png_bytep out_px = &(temp_rows[y][ox * 4]);
+            out_px[0] = (uint8_t)r;
+            out_px[1] = (uint8_t)g;
+            out_px[2] = (uint8_t)b;
+            out_px[3] = (uint8_t)a;
+        }
+    }
+
+    // Vertical pass: only the output rows
+    png_bytep *out_rows = allocate_rows(out_width, out_height);
+    for (int oy = 0; oy < out_height; oy++)
+    {
+        const float *w = &y_weights[oy * y_taps];
+
+        for (int ox = 0; ox < out_width; ox++)
+        {
+            float r = 0, g = 0, b = 0, a = 0;
+
+            for (int i = 0; i < y_taps; i++)
+            {
+                int iy = y_starts[oy] + i;
+                // Handle boundary conditions
+                if (iy < 0)
+                    iy = 0;
+                if (iy >= height)
+                    iy = height - 1;
+
+                png_bytep px = &(temp_rows[iy][ox * 4]);
+                r += px[0] * w[i];
+                g += px[1] * w[i];
+                b += px[2] * w[i];
+                a += px[3] * w[i];
+            }
+
+            png_bytep out_px = &(out_rows[oy][ox * 4]);
+            out_px[0] = (uint8_t)r;
+            out_px[1] = (uint8_t)g;
+            out_px[2] = (uint8_t)b;
+            out_px[3] = (uint8_t)a;
+        }
+    }
+
+    free_rows(temp_rows, height);
+    free(x_weights);
+    free(y_weights);
+    free(x_starts);
+    free(y_starts);
+    return out_rows;
+}
+
+// Time one strategy on a synthetic image, averaging over repeated runs until
+// at least CALIBRATION_MIN_TIME seconds have been measured
+double benchmark_config(png_bytep *source, png_bytep *work, int width, int height, int radius, struct tune_config config)
+{
+    double total = 0.0;
+    int runs = 0;
+
+    while (total < CALIBRATION_MIN_TIME)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            memcpy(work[y], source[y], width * 4);
+        }
+
+        double start = get_wall_time();
+        apply_gaussian_blur(work, width, height, radius, config);
+        total += get_wall_time() - start;
+        runs++;
+    }
+
+    return total / runs;
+}
+
+// Benchmark a candidate strategy and keep it only if it beats the current best by
+// CALIBRATION_MARGIN, so that measurement noise does not end up in the profile
+void try_config(png_bytep *source, png_bytep *work, int width, int height, int radius,
+                struct tune_config candidate, struct tune_config *best, double *best_time)
+{
+    double candidate_time = benchmark_config(source, work, width, height, radius, candidate);
+    if (candidate_time < *best_time * CALIBRATION_MARGIN)
+    {
+        *best = candidate;
+        *best_time = candidate_time;
+    }
+}
+
+// Micro-benchmark every CPU code path over a sweep of square image sizes and radii and save the winners
+void calibrate(const char *profile_file)
+{
+    const int widths[] = {256, 512, 1024, 2048};
+    const int radii[] = {2, 8, 32, 96};
+    const int tiled_tiles[] = {32, 64, 128};
+    const int transpose_tiles[] = {8, 16, 32};
+    const int num_widths = sizeof(widths) / sizeof(widths[0]);
+    const int num_radii = sizeof(radii) / sizeof(radii[0]);
+    const int num_tiled_tiles = sizeof(tiled_tiles) / sizeof(tiled_tiles[0]);
+    const int num_transpose_tiles = sizeof(transpose_tiles) / sizeof(transpose_tiles[0]);
+
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_threads = cores > 0 ? (int)cores : 1;
+
+    struct tune_profile profile;
+    profile.count = 0;
+    profile.entries = (struct tune_entry *)malloc(num_widths * num_radii * sizeof(struct tune_entry));
+
+    printf("Calibrating on %d core(s)\n", max_threads);
+    srand(548);
+
+    for (int w = 0; w < num_widths; w++)
+    {
+        for (int r = 0; r < num_radii; r++)
+        {
+            int width = widths[w];
+            int radius = radii[r];
+            // Benchmark full square images: the transpose path blurs rows as long as
+            // the image height, and run_pass splits the work across threads by height
+            int height = width;
+
+            png_bytep *source = allocate_rows(width, height);
+            png_bytep *work = allocate_rows(width, height);
+            for (int y = 0; y < height; y++)
+            {
+                for (int x = 0; x < width * 4; x++)
+                {
+                    source[y][x] = rand() & 0xFF;
+                }
+            }
+
+            // Pick the algorithm and tile single-threaded, then scale the winner across threads
+            struct tune_config best = default_tune_config();
+            double best_time = benchmark_config(source, work, width, height, radius, best);
+            for (int t = 0; t < num_tiled_tiles; t++)
+            {
+                struct tune_config tiled = {BLUR_TILED, tiled_tiles[t], 1};
+                try_config(source, work, width, height, radius, tiled, &best, &best_time);
+            }
+            for (int t = 0; t < num_transpose_tiles; t++)
+            {
+                struct tune_config transposed = {BLUR_TRANSPOSE, transpose_tiles[t], 1};
+                struct tune_config box = {BLUR_BOX, transpose_tiles[t], 1};
+                try_config(source, work, width, height, radius, transposed, &best, &best_time);
+                try_config(source, work, width, height, radius, box, &best, &best_time);
+            }
+
+            // Sweep powers of two, always finishing on max_threads
+            for (int threads = 2; threads <= max_threads; threads *= 2)
+            {
+                if (threads * 2 > max_threads)
+                    threads = max_threads;
+                struct tune_config candidate = best;
+                candidate.threads = threads;
+                try_config(source, work, width, height, radius, candidate, &best, &best_time);
+            }
+
+            struct tune_entry *entry = &profile.entries[profile.count++];
+            entry->size = width;
+            entry->radius = radius;
+            entry->config = best;
+            entry->seconds = best_time;
+            printf("size %4d radius %3d: %-9s tile %3d threads %2d (%f seconds)\n", width, radius,
+                   tune_algorithm_name(best.algorithm), best.tile, best.threads, best_time);
+
+            free_rows(source, height);
+            free_rows(work, height);
+        }
+    }
+
+    save_tune_profile(profile_file, &profile);
+    printf("Tuning profile written to %s\n", profile_file);
+    free_tune_profile(&profile);
+}
+
 int main(int argc, char *argv[])
 {
 
     const char *input_file = "spidey.png";
     const char *output_file = "out_serial.png";
+    const char *profile_file = DEFAULT_PROFILE;
     int blur_radius = 10; // Default value
+    float scale = 0;      // Downscale factor, 0 keeps the full resolution
+    int out_width = 0, out_height = 0;
+
+    if (argc > 1 && strcmp(argv[1], "--calibrate") == 0)
+    {
+        if (argc > 2)
+            profile_file = argv[2];
+        calibrate(profile_file);
+        return 0;
+    }
+
     if (argc > 1)
     {
         blur_radius = atoi(argv[1]);
@@ -143,12 +680,47 @@ int main(int argc, char *argv[])
     {
         printf("No blur radius specified. Using default value: 10\n");
     }
+    for (int i = 3; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc)
+        {
+            profile_file = argv[++i];
+        }
+        else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc)
+        {
+            scale = atof(argv[++i]);
+            if (!(scale >= 1))
+            {
+                printf("Invalid scale factor. It must be at least 1\n");
+                return EXIT_FAILURE;
+            }
+        }
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+        {
+            if (sscanf(argv[++i], "%dx%d", &out_width, &out_height) != 2 || out_width <= 0 || out_height <= 0)
+            {
+                printf("Invalid output size. Expected <width>x<height>\n");
+                return EXIT_FAILURE;
+            }
+        }
+        else
+        {
+            printf("Unknown option: %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (scale > 0 && out_width > 0)
+    {
+        printf("Use either --scale or --size, not both\n");
+        return EXIT_FAILURE;
+    }
     printf("Using blur radius: %d\n", blur_radius);
 
     png_bytep *row_pointers;
     int width, height;
-    clock_t start, end, read_start, read_end, write_start, write_end;
-    double cpu_time_used, read_time_used, write_time_used;
+    clock_t read_start, read_end, write_start, write_end;
+    double start, end;
+    double blur_time_used, read_time_used, write_time_used;
 
     // Start measuring read time
     printf("Reading image from %s\n", input_file);
@@ -158,12 +730,55 @@ int main(int argc, char *argv[])
     read_time_used = ((double)(read_end - read_start)) / CLOCKS_PER_SEC;
     printf("Image read successfully\nImage dimensions: %d x %d\n\n", width, height);
 
-    // Start measuring processing time
+    int downscale = scale > 0 || out_width > 0;
+    if (scale > 0)
+    {
+        out_width = (int)fmax(1, roundf(width / scale));
+        out_height = (int)fmax(1, roundf(height / scale));
+    }
+    if (downscale && (out_width > width || out_height > height))
+    {
+        printf("Output size %d x %d is larger than the input image\n", out_width, out_height);
+        return EXIT_FAILURE;
+    }
+
+    // Pick the fastest known strategy for this job (the fused downscale has a single code path)
+    struct tune_profile profile;
+    struct tune_config config = default_tune_config();
+    if (downscale)
+    {
+        printf("Using fused blur and downscale to %d x %d\n\n", out_width, out_height);
+    }
+    else if (load_tune_profile(profile_file, &profile))
+    {
+        config = select_tune_config(&profile, width, height, blur_radius);
+        free_tune_profile(&profile);
+        printf("Loaded tuning profile from %s\n", profile_file);
+    }
+    else
+    {
+        printf("No tuning profile at %s, run with --calibrate to create one\n", profile_file);
+    }
+    if (!downscale)
+        printf("Using %s blur (tile %d, %d thread(s))\n\n", tune_algorithm_name(config.algorithm), config.tile, config.threads);
+
+    // Start measuring processing time (wall clock, since the blur may be multithreaded)
     printf("Starting Blurring Process\n");
-    start = clock();
-    apply_gaussian_blur(row_pointers, width, height, blur_radius);
-    end = clock();
-    cpu_time_used = ((double)(end - start)) / CLOCKS_PER_SEC;
+    start = get_wall_time();
+    if (downscale)
+    {
+        png_bytep *out_rows = apply_gaussian_blur_downscale(row_pointers, width, height, blur_radius, out_width, out_height);
+        free_rows(row_pointers, height);
+        row_pointers = out_rows;
+        width = out_width;
+        height = out_height;
+    }
+    else
+    {
+        apply_gaussian_blur(row_pointers, width, height, blur_radius, config);
+    }
+    end = get_wall_time();
+    blur_time_used = end - start;
     printf("Blurring Process Completed\n\n");
 
     // Start measuring write time
@@ -175,16 +790,12 @@ int main(int argc, char *argv[])
     printf("Image written successfully\n\n");
 
     printf("Freeing memory\n");
-    for (int y = 0; y < height; y++)
-    {
-        free(row_pointers[y]);
-    }
-    free(row_pointers);
+    free_rows(row_pointers, height);
     printf("Memory freed\n\n");
 
     printf("Execution Summary:\n");
     printf("Time taken for reading: %f seconds\n", read_time_used);
-    printf("Time taken for Gaussian blur with %d radius: %f seconds\n", blur_radius, cpu_time_used);
+    printf("Time taken for Gaussian blur with %d radius: %f seconds\n", blur_radius, blur_time_used);
     printf("Time taken for writing: %f seconds\n", write_time_used);
     return 0;
 }